@@ -1,5 +1,10 @@
 #include "inc/mqtt.h"
 
+#if MQTT_FILA_TOPICO_SZ + MQTT_FILA_PAYLOAD_SZ + MQTT_FILA_OVERHEAD >         \
+    MQTT_OUTPUT_RINGBUF_SIZE
+#error "Itens da fila MQTT nao cabem em MQTT_OUTPUT_RINGBUF_SIZE"
+#endif
+
 static mqtt_client_t *client;
 uint32_t last_timestamp = 0;
 
@@ -8,6 +13,26 @@ static mqtt_app_msg_cb_t s_app_cb = NULL;
 static char s_rxbuf[RXBUF_SZ];
 static u16_t s_rxofs = 0;
 
+typedef struct {
+  char topic[MQTT_FILA_TOPICO_SZ];
+  char payload[MQTT_FILA_PAYLOAD_SZ];
+  uint8_t qos;
+  uint8_t retain;
+} mqtt_fila_item_t;
+
+static mqtt_fila_item_t s_fila[MQTT_FILA_TAM];
+static uint8_t s_fila_ini = 0;
+static uint8_t s_fila_qtd = 0;
+
+// Conexão guardada para reconectar a partir das janelas de rádio
+static ip_addr_t s_broker_addr;
+static struct mqtt_connect_client_info_t s_ci;
+
+// Heartbeat QoS 1: o PUBACK confirma que a conexão está viva
+static bool s_hb_pendente = false;
+static bool s_hb_falhou = false;
+static uint32_t s_ultimo_hb_ms = 0;
+
 void mqtt_set_app_callback(mqtt_app_msg_cb_t cb) { s_app_cb = cb; }
 
 /**
@@ -19,10 +44,14 @@ void mqtt_set_app_callback(mqtt_app_msg_cb_t cb) { s_app_cb = cb; }
  */
 static void mqtt_connection_callback(mqtt_client_t *client, void *arg,
                                      mqtt_connection_status_t status) {
-  if (status == MQTT_CONNECT_ACCEPTED)
+  if (status == MQTT_CONNECT_ACCEPTED) {
     printf("Conectado ao broker MQTT.\n");
-  else
+    s_ultimo_hb_ms = to_ms_since_boot(get_absolute_time());
+  } else {
     printf("Falha ao conectar ao broker: %d\n", status);
+  }
+  // Requisições pendentes são descartadas pelo lwIP ao fechar a conexão
+  s_hb_pendente = false;
 
   mqtt_set_inpub_callback(client, pub_cb, data_cb, NULL);
 }
@@ -37,9 +66,7 @@ static void mqtt_connection_callback(mqtt_client_t *client, void *arg,
  */
 void mqtt_setup(const char *client_id, const char *broker_ip, const char *user,
                 const char *pass) {
-  ip_addr_t broker_addr;
-
-  if (!ipaddr_aton(broker_ip, &broker_addr)) {
+  if (!ipaddr_aton(broker_ip, &s_broker_addr)) {
     printf("Erro no IP.\n");
     return;
   }
@@ -50,11 +77,13 @@ void mqtt_setup(const char *client_id, const char *broker_ip, const char *user,
     return;
   }
 
-  struct mqtt_connect_client_info_t ci = {
-      .client_id = client_id, .client_user = user, .client_pass = pass};
+  s_ci = (struct mqtt_connect_client_info_t){.client_id = client_id,
+                                             .client_user = user,
+                                             .client_pass = pass,
+                                             .keep_alive = MQTT_KEEPALIVE_S};
 
-  mqtt_client_connect(client, &broker_addr, BROKER_PORT,
-                      mqtt_connection_callback, NULL, &ci);
+  mqtt_client_connect(client, &s_broker_addr, BROKER_PORT,
+                      mqtt_connection_callback, NULL, &s_ci);
 }
 
 /**
@@ -130,4 +159,134 @@ void mqtt_conn_subscribe(const char *topic, uint8_t qos) {
     printf("Erro ao se inscrever no tópico '%s': %d\n", topic, err);
   else
     printf("Inscrito no tópico '%s'.\n", topic);
-}
\ No newline at end of file
+}
+
+/**
+ * Enfileira uma publicação para ser enviada na próxima janela de rádio
+ * acordado (ver wifi_ps_configurar).
+ *
+ * @param topic Tópico onde a mensagem será publicada.
+ * @param json Payload já formatado.
+ * @return false se a fila estiver cheia ou a mensagem não couber.
+ */
+bool mqtt_enfileirar_json_raw(const char *topic, const char *json, uint8_t qos,
+                              uint8_t retain) {
+  if (strlen(topic) >= MQTT_FILA_TOPICO_SZ ||
+      strlen(json) >= MQTT_FILA_PAYLOAD_SZ) {
+    printf("Mensagem grande demais para a fila MQTT.\n");
+    return false;
+  }
+
+  // A fila é esvaziada pelo worker de economia de energia (async_context)
+  cyw43_arch_lwip_begin();
+  if (s_fila_qtd == MQTT_FILA_TAM) {
+    cyw43_arch_lwip_end();
+    printf("Fila MQTT cheia, descartando mensagem.\n");
+    return false;
+  }
+
+  mqtt_fila_item_t *it = &s_fila[(s_fila_ini + s_fila_qtd) % MQTT_FILA_TAM];
+  strcpy(it->topic, topic);
+  strcpy(it->payload, json);
+  it->qos = qos;
+  it->retain = retain;
+  s_fila_qtd++;
+  cyw43_arch_lwip_end();
+  return true;
+}
+
+/**
+ * Callback do PUBACK do heartbeat. Sem resposta (timeout) ou com erro, a
+ * conexão é refeita na próxima janela.
+ *
+ * @param arg Argumento adicional (não utilizado).
+ * @param result Resultado da publicação.
+ */
+static void mqtt_heartbeat_callback(void *arg, err_t result) {
+  s_hb_pendente = false;
+  if (result == ERR_OK) {
+    s_ultimo_hb_ms = to_ms_since_boot(get_absolute_time());
+  } else {
+    printf("Heartbeat MQTT sem resposta: %d\n", result);
+    s_hb_falhou = true;
+  }
+}
+
+/**
+ * Publica um heartbeat QoS 1 a cada MQTT_HEARTBEAT_MS. Deve ser chamada
+ * com o lock do lwIP e o cliente conectado.
+ */
+static void mqtt_heartbeat(void) {
+  uint32_t agora = to_ms_since_boot(get_absolute_time());
+  char json[32];
+
+  if (s_hb_pendente || agora - s_ultimo_hb_ms < MQTT_HEARTBEAT_MS)
+    return;
+
+  int l = snprintf(json, sizeof(json), "{\"ts\": %lu}", (unsigned long)agora);
+  err_t response = mqtt_publish(client, MQTT_TOPICO_HEARTBEAT, json, l, 1, 0,
+                                mqtt_heartbeat_callback, NULL);
+  if (response == ERR_OK)
+    s_hb_pendente = true;
+}
+
+/**
+ * Derruba a conexão se o último heartbeat falhou e reconecta ao broker se
+ * o link Wi-Fi estiver de pé. Deve ser chamada com o lock do lwIP.
+ */
+static void mqtt_verificar_conexao(void) {
+  if (s_hb_falhou) {
+    s_hb_falhou = false;
+    if (mqtt_client_is_connected(client)) {
+      printf("Conexão MQTT inativa, desconectando.\n");
+      mqtt_disconnect(client);
+      s_hb_pendente = false;
+    }
+  }
+
+  if (mqtt_client_is_connected(client) ||
+      cyw43_tcpip_link_status(&cyw43_state, CYW43_ITF_STA) != CYW43_LINK_UP)
+    return;
+
+  // ERR_ISCONN: conexão anterior ainda em andamento
+  if (mqtt_client_connect(client, &s_broker_addr, BROKER_PORT,
+                          mqtt_connection_callback, NULL, &s_ci) == ERR_OK)
+    printf("Reconectando ao broker MQTT.\n");
+}
+
+/**
+ * Publica as mensagens enfileiradas. O que não puder ser enviado agora
+ * (sem conexão ou sem memória no lwIP) fica para a próxima tentativa;
+ * outros erros descartam a mensagem para não travar a fila.
+ *
+ * @param abertura_janela true na primeira chamada de uma janela de rádio:
+ * verifica a conexão (reconectando se preciso) e envia o heartbeat.
+ */
+void mqtt_flush_fila(bool abertura_janela) {
+  if (!client || (!s_fila_qtd && !abertura_janela))
+    return;
+
+  cyw43_arch_lwip_begin();
+  if (abertura_janela)
+    mqtt_verificar_conexao();
+
+  if (mqtt_client_is_connected(client)) {
+    while (s_fila_qtd) {
+      mqtt_fila_item_t *it = &s_fila[s_fila_ini];
+      err_t response =
+          mqtt_publish(client, it->topic, it->payload, strlen(it->payload),
+                       it->qos, it->retain, mqtt_pub_request_callback, NULL);
+      if (response == ERR_MEM || response == ERR_CONN) {
+        // Buffer de saída cheio ou sem conexão: tenta no próximo tick
+        break;
+      }
+      if (response != ERR_OK)
+        printf("Erro ao publicar (fila), descartando: %d\n", response);
+      s_fila_ini = (s_fila_ini + 1) % MQTT_FILA_TAM;
+      s_fila_qtd--;
+    }
+    if (abertura_janela)
+      mqtt_heartbeat();
+  }
+  cyw43_arch_lwip_end();
+}
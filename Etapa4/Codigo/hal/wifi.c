@@ -1,6 +1,13 @@
 #include "wifi.h"
 
+// Credenciais guardadas para reconectar a partir das janelas de rádio
+static const char *s_ssid = NULL;
+static const char *s_pswd = NULL;
+
 int connect_wifi(const char *ssid, const char *password) {
+  s_ssid = ssid;
+  s_pswd = password;
+
   if (cyw43_arch_init()) {
     printf("Erro ao inicializar Wi-Fi.\n");
     return -1;
@@ -16,4 +23,172 @@ int connect_wifi(const char *ssid, const char *password) {
 
   printf("Conectado a: %s.\n", ssid);
   return 1;
-}
\ No newline at end of file
+}
+
+// ================== Presets de economia de energia ==================
+// Maior período de DTIM do AP suportado pelos presets. O rádio anuncia ao AP
+// que escuta a cada li_assoc beacons, mas acorda a cada li_beacon beacons ou
+// li_dtim DTIMs; li_beacon * li_dtim * WIFI_PS_AP_DTIM_MAX deve caber em
+// li_assoc, senão o AP pode descartar quadros guardados ou desassociar.
+#define WIFI_PS_AP_DTIM_MAX 3
+
+typedef struct {
+  uint8_t pm_modo;     // CYW43_*_POWERSAVE_MODE entre janelas
+  uint16_t pm2_ret_ms; // tempo acordado após tráfego (PM2)
+  uint8_t li_beacon;   // intervalo de escuta em beacons
+  uint8_t li_dtim;     // intervalo de escuta em DTIMs
+  uint8_t li_assoc;    // intervalo de escuta anunciado ao AP (beacons)
+  uint32_t periodo_ms; // intervalo entre janelas
+  uint32_t janela_ms;  // tempo acordado em cada janela
+} wifi_ps_cfg_t;
+
+static const wifi_ps_cfg_t PS_PRESETS[] = {
+    // Igual a CYW43_DEFAULT_PM
+    [WIFI_PS_DESLIGADO] = {CYW43_PM2_POWERSAVE_MODE, 200, 1, 1, 10, 0, 0},
+    // PM2 com retenção de 20 ms (o padrão é 200 ms), escuta todo DTIM
+    [WIFI_PS_BAIXA_LATENCIA] = {CYW43_PM2_POWERSAVE_MODE, 20, 1, 1, 10, 1000,
+                                20},
+    // PM2, escuta a cada 3 DTIMs
+    [WIFI_PS_EQUILIBRADO] = {CYW43_PM2_POWERSAVE_MODE, 20, 1, 3, 10, 5000,
+                             150},
+    // PM1 (PS-Poll), escuta a cada 4 DTIMs
+    [WIFI_PS_ECONOMIA] = {CYW43_PM1_POWERSAVE_MODE, 10, 1, 4, 12, 30000, 300},
+};
+
+// Intervalo entre chamadas do flush com o rádio acordado
+#define WIFI_PS_FLUSH_MS 20
+// Sem economia, intervalo entre verificações de conexão/keepalive
+#define WIFI_PS_CHECAGEM_MS 1000
+
+static wifi_ps_preset_t s_ps_preset = WIFI_PS_DESLIGADO;
+static wifi_ps_flush_cb_t s_ps_flush_cb = NULL;
+static bool s_ps_acordado = false;
+static uint32_t s_ps_pm_ocioso = 0;   // cyw43_pm_value() do preset atual
+static uint32_t s_ps_fim_ms = 0;      // fim da janela atual
+static uint32_t s_ps_checagem_ms = 0; // próxima verificação (sem economia)
+
+static void ps_worker(async_context_t *ctx, async_at_time_worker_t *w);
+static async_at_time_worker_t s_ps_worker = {.do_work = ps_worker};
+
+void wifi_ps_set_flush_callback(wifi_ps_flush_cb_t cb) { s_ps_flush_cb = cb; }
+
+/**
+ * Tempo até o início da próxima janela, alinhada a múltiplos do período.
+ *
+ * @param agora Tempo atual em ms desde o boot.
+ * @param periodo Período das janelas em ms.
+ */
+static uint32_t ps_ate_proxima_janela(uint32_t agora, uint32_t periodo) {
+  return (agora / periodo + 1) * periodo - agora;
+}
+
+static void ps_aplicar_pm(uint32_t pm) {
+  int r = cyw43_wifi_pm(&cyw43_state, pm);
+  if (r != 0)
+    printf("Erro ao ajustar modo PM do rádio: %d\n", r);
+}
+
+/**
+ * Reinicia a associação se o link Wi-Fi caiu. Uma associação em andamento
+ * (CYW43_LINK_JOIN/NOIP) não é interrompida.
+ */
+static void ps_verificar_link(void) {
+  int st = cyw43_tcpip_link_status(&cyw43_state, CYW43_ITF_STA);
+
+  if (!s_ssid || (st != CYW43_LINK_DOWN && st >= 0))
+    return;
+
+  printf("Wi-Fi desconectado (%d), reconectando.\n", st);
+  if (cyw43_arch_wifi_connect_async(s_ssid, s_pswd, CYW43_AUTH_WPA2_AES_PSK))
+    printf("Erro ao reconectar Wi-Fi.\n");
+}
+
+static void ps_flush(bool abertura) {
+  if (abertura)
+    ps_verificar_link();
+  if (s_ps_flush_cb)
+    s_ps_flush_cb(abertura);
+}
+
+/**
+ * Máquina de estados das janelas de rádio, executada no async_context do
+ * CYW43 (não depende do laço principal, que pode ficar bloqueado durante
+ * uma separação). Ao abrir a janela, acorda o rádio (sem economia);
+ * enquanto ela estiver aberta o callback de flush é chamado a cada
+ * WIFI_PS_FLUSH_MS (com abertura = true apenas na primeira vez). Ao fechar,
+ * retorna ao modo PM ocioso do preset e agenda a próxima janela. Sem
+ * economia (WIFI_PS_DESLIGADO) o flush roda continuamente e a abertura é
+ * simulada a cada WIFI_PS_CHECAGEM_MS. Na abertura o link Wi-Fi é
+ * verificado e reconectado se necessário.
+ */
+static void ps_worker(async_context_t *ctx, async_at_time_worker_t *w) {
+  const wifi_ps_cfg_t *cfg = &PS_PRESETS[s_ps_preset];
+  uint32_t agora = to_ms_since_boot(get_absolute_time());
+
+  if (!cfg->periodo_ms) {
+    bool checagem = (int32_t)(agora - s_ps_checagem_ms) >= 0;
+    if (checagem)
+      s_ps_checagem_ms = agora + WIFI_PS_CHECAGEM_MS;
+    ps_flush(checagem);
+    async_context_add_at_time_worker_in_ms(ctx, w, WIFI_PS_FLUSH_MS);
+    return;
+  }
+
+  if (!s_ps_acordado) {
+    ps_aplicar_pm(CYW43_NONE_PM);
+    s_ps_acordado = true;
+    s_ps_fim_ms = agora + cfg->janela_ms;
+    ps_flush(true);
+  } else if ((int32_t)(agora - s_ps_fim_ms) >= 0) {
+    ps_aplicar_pm(s_ps_pm_ocioso);
+    s_ps_acordado = false;
+    async_context_add_at_time_worker_in_ms(
+        ctx, w, ps_ate_proxima_janela(agora, cfg->periodo_ms));
+    return;
+  } else {
+    ps_flush(false);
+  }
+
+  uint32_t resta = s_ps_fim_ms - agora;
+  async_context_add_at_time_worker_in_ms(
+      ctx, w, resta < WIFI_PS_FLUSH_MS ? resta : WIFI_PS_FLUSH_MS);
+}
+
+/**
+ * Seleciona o preset de economia de energia, coloca o rádio no modo PM
+ * ocioso correspondente e agenda as janelas. Requer o Wi-Fi já inicializado
+ * (connect_wifi).
+ *
+ * @param preset Compromisso latência x consumo desejado.
+ */
+void wifi_ps_configurar(wifi_ps_preset_t preset) {
+  if ((unsigned)preset >= sizeof(PS_PRESETS) / sizeof(PS_PRESETS[0])) {
+    printf("Preset de economia invalido: %d\n", (int)preset);
+    return;
+  }
+
+  const wifi_ps_cfg_t *cfg = &PS_PRESETS[preset];
+  async_context_t *ctx = cyw43_arch_async_context();
+
+  if (cfg->li_beacon * cfg->li_dtim * WIFI_PS_AP_DTIM_MAX > cfg->li_assoc)
+    printf("Aviso: intervalo de escuta maior que o anunciado ao AP.\n");
+
+  async_context_acquire_lock_blocking(ctx);
+  async_context_remove_at_time_worker(ctx, &s_ps_worker);
+
+  s_ps_preset = preset;
+  s_ps_acordado = false;
+  s_ps_checagem_ms = to_ms_since_boot(get_absolute_time());
+  // cyw43_pm_value() é uma função inline, não pode ir na tabela estática
+  s_ps_pm_ocioso = cyw43_pm_value(cfg->pm_modo, cfg->pm2_ret_ms,
+                                  cfg->li_beacon, cfg->li_dtim, cfg->li_assoc);
+  ps_aplicar_pm(s_ps_pm_ocioso);
+
+  uint32_t espera =
+      cfg->periodo_ms
+          ? ps_ate_proxima_janela(to_ms_since_boot(get_absolute_time()),
+                                  cfg->periodo_ms)
+          : WIFI_PS_FLUSH_MS;
+  async_context_add_at_time_worker_in_ms(ctx, &s_ps_worker, espera);
+  async_context_release_lock(ctx);
+}
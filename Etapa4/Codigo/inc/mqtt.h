@@ -3,6 +3,7 @@
 
 #include "lwip/apps/mqtt.h"
 #include "lwipopts.h"
+#include "pico/cyw43_arch.h"
 #include "pico/stdlib.h"
 #include "string.h"
 #include "time.h"
@@ -12,6 +13,22 @@
 #define BROKER_IP "172.19.10.129" // 192.168.1.113
 #define MQTT_USER "user1"
 #define MQTT_PASS "trt567"
+#define MQTT_TOPICO_COR "robo/cor"
+// Heartbeat QoS 1 publicado na abertura de uma janela de rádio (ver wifi.h);
+// sem PUBACK a conexão é refeita na janela seguinte. Como todo envio zera o
+// contador de keepalive do lwIP, o PINGREQ dele (após MQTT_KEEPALIVE_S sem
+// envio, múltiplo dos períodos dos presets) só sai fora de uma janela se as
+// janelas pararem de rodar.
+#define MQTT_TOPICO_HEARTBEAT "robo/heartbeat"
+#define MQTT_HEARTBEAT_MS 60000
+#define MQTT_KEEPALIVE_S 120
+// Fila de publicações enviada nas janelas de rádio acordado
+#define MQTT_FILA_TAM 8
+#define MQTT_FILA_TOPICO_SZ 64
+#define MQTT_FILA_PAYLOAD_SZ 256
+// Cabeçalho fixo (1) + comprimento restante (2) + tamanho do tópico (2) +
+// packet id (2)
+#define MQTT_FILA_OVERHEAD 7
 
 void mqtt_setup(const char *client_id, const char *broker_ip, const char *user,
                 const char *pass);
@@ -27,4 +44,8 @@ typedef void (*mqtt_app_msg_cb_t)(const char *topic, const char *payload,
                                   uint16_t len);
 void mqtt_set_app_callback(mqtt_app_msg_cb_t cb);
 
+bool mqtt_enfileirar_json_raw(const char *topic, const char *json, uint8_t qos,
+                              uint8_t retain);
+void mqtt_flush_fila(bool abertura_janela);
+
 #endif
\ No newline at end of file
@@ -2,6 +2,7 @@
 #define WIFI_H
 
 #include "pico/cyw43_arch.h"
+#include <stdbool.h>
 #include <stdio.h>
 
 #define FINATECH_SSID "AP-ACCESS BLH"
@@ -11,4 +12,32 @@
 
 int connect_wifi(const char *ssid, const char *password);
 
-#endif
\ No newline at end of file
+// --- Economia de energia do rádio ---
+// Entre as janelas o CYW43 fica em um modo PM de baixo consumo; a cada
+// período (alinhado ao tempo desde o boot) o rádio é acordado, a fila MQTT
+// é esvaziada e, após a janela, ele volta a dormir. As janelas rodam em um
+// worker do async_context do CYW43, independentes do laço principal.
+//
+// Uso (ver robo.c):
+//   connect_wifi(SSID, PSWD);
+//   mqtt_setup(...);
+//   wifi_ps_set_flush_callback(mqtt_flush_fila);
+//   wifi_ps_configurar(WIFI_PS_EQUILIBRADO);
+//   telemetria: mqtt_enfileirar_json_raw(...).
+typedef enum {
+  WIFI_PS_DESLIGADO = 0,  // rádio sempre no modo padrão do SDK
+  WIFI_PS_BAIXA_LATENCIA, // janelas curtas e frequentes (1 s)
+  WIFI_PS_EQUILIBRADO,    // compromisso latência x consumo (5 s)
+  WIFI_PS_ECONOMIA,       // máximo de economia, alta latência (30 s)
+} wifi_ps_preset_t;
+
+// Chamada periodicamente com o rádio acordado, no contexto do async_context
+// (ex.: mqtt_flush_fila); deve retornar rápido quando não houver nada a
+// enviar. abertura é true na primeira chamada de cada janela (momento de
+// verificar a conexão e enviar keepalives).
+typedef void (*wifi_ps_flush_cb_t)(bool abertura);
+
+void wifi_ps_set_flush_callback(wifi_ps_flush_cb_t cb);
+void wifi_ps_configurar(wifi_ps_preset_t preset);
+
+#endif
@@ -102,4 +102,9 @@
 // fluxo de mensagens no protocolo MQTT
 #define MQTT_REQ_MAX_IN_FLIGHT (5)
 
+// Tamanho do buffer circular de saída do cliente MQTT (padrão do lwIP: 256
+// bytes). Precisa comportar o maior item da fila de publicações (tópico +
+// payload + cabeçalho MQTT), ver MQTT_FILA_* em mqtt.h
+#define MQTT_OUTPUT_RINGBUF_SIZE 512
+
 #endif /* __LWIPOPTS_H__ */
\ No newline at end of file
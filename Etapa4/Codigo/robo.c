@@ -42,6 +42,14 @@ int main() {
   tcs_enable();
   sleep_ms(700);
 
+  // Rede: telemetria MQTT enviada nas janelas de rádio acordado
+  bool rede_ok = connect_wifi(SSID, PSWD) > 0;
+  if (rede_ok) {
+    mqtt_setup(CLIENT_ID, BROKER_IP, MQTT_USER, MQTT_PASS);
+    wifi_ps_set_flush_callback(mqtt_flush_fila);
+    wifi_ps_configurar(WIFI_PS_EQUILIBRADO);
+  }
+
   // Vai para a posição de transporte ao iniciar
   garra_ir_para(POSICAO_TRANSPORTE);
   printf("Pressione o Botao B para iniciar a tarefa.\n");
@@ -61,6 +69,12 @@ int main() {
         garra_seq_soltar(cor);
         garra_ir_para(POSICAO_INICIAL);
 
+        if (rede_ok) {
+          char json[32];
+          snprintf(json, sizeof(json), "{\"cor\": %d}", cor);
+          mqtt_enfileirar_json_raw(MQTT_TOPICO_COR, json, 0, 0);
+        }
+
         while (!gpio_get(TRIGGER_BUTTON_PIN))
           ; // espera soltar botão
       }